@@ -6,12 +6,36 @@
 #include <array>
 #include <unordered_map>
 #include <algorithm>
+#include <chrono>
+#include <cassert>
 
 using namespace std;
 
 const int CHANNELS = 100;
 const int MAX_SEGMENTS = 3;
 
+// 搜索预算: 出队状态数上限与截止时间, 任一耗尽即返回当前最优解
+struct SearchLimits {
+    long long max_expansions = -1; // -1 表示不限
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max();
+    
+    bool exhausted(long long expansions) const {
+        if (max_expansions >= 0 && expansions >= max_expansions) {
+            return true;
+        }
+        return deadline != chrono::steady_clock::time_point::max() && (expansions & 255) == 0 &&
+               chrono::steady_clock::now() >= deadline;
+    }
+};
+
+// 任意时刻搜索结果: cost - lower_bound 即最优性差距
+struct AnytimeResult {
+    vector<pair<int, int>> path; // 当前最优路径 (未找到时为空)
+    int cost = INT_MAX;          // path 的代价
+    int lower_bound = 0;         // 最优代价的已证明下界
+    bool optimal = false;        // cost 已证明最优 (搜索完成, 或预算耗尽时下界已达到 cost)
+};
+
 class OptimizedEfficientGraph {
 private:
     int n; // 节点数
@@ -74,6 +98,11 @@ public:
     
     // 返回路径：vector<pair<节点ID, 起始通道ID>>，起始通道ID为-1表示未开始或结束
     vector<pair<int, int>> findMinCostPath(int source, int target) {
+        return findMinCostPath(source, target, SearchLimits()).path;
+    }
+    
+    // 带预算的版本: 预算耗尽时返回 min_cost/best_final_state 记录的当前最优解
+    AnytimeResult findMinCostPath(int source, int target, const SearchLimits& limits) {
         const int STATE_COUNT = 101; // 100通道 + 特殊状态(100)
         const int TOTAL_STATES = n * STATE_COUNT;
         
@@ -90,8 +119,14 @@ public:
         
         int min_cost = INT_MAX;
         int best_final_state = -1;
+        long long expansions = 0;
+        bool completed = true;
         
         while (!pq.empty()) {
+            if (limits.exhausted(expansions++)) {
+                completed = false;
+                break;
+            }
             PathState current = pq.top();
             pq.pop();
             
@@ -186,8 +221,13 @@ public:
             }
         }
         
-        // 重构路径
-        return reconstructPath(best_final_state, prev_state, start_channel, source, target, STATE_COUNT);
+        // 重构路径; 未完成时堆中最小代价即下界, 下界达到当前代价时同样已证明最优
+        AnytimeResult result;
+        result.path = reconstructPath(best_final_state, prev_state, start_channel, source, target, STATE_COUNT);
+        result.cost = min_cost;
+        result.lower_bound = completed ? min_cost : min(min_cost, pq.top().cost);
+        result.optimal = completed || (best_final_state != -1 && result.lower_bound == min_cost);
+        return result;
     }
     
 private:
@@ -422,6 +462,46 @@ void runTestCases() {
         }
     }
     
+    // 测试用例6：带预算的任意时刻搜索
+    {
+        cout << "\n测试用例6: 带预算的任意时刻搜索" << endl;
+        const int NODES = 30;
+        OptimizedEfficientGraph graph(NODES);
+        
+        for (int i = 0; i < NODES; i++) {
+            graph.setChannelSwitchSupport(i, i % 3 == 0);
+        }
+        for (int i = 0; i < NODES - 1; i++) {
+            graph.addEdge(i, i + 1, TestCaseGenerator::generateLinearCosts(1 + i % 4, 1));
+        }
+        
+        AnytimeResult exact = graph.findMinCostPath(0, NODES - 1, SearchLimits());
+        cout << "完整搜索: 代价=" << exact.cost << ", 下界=" << exact.lower_bound
+             << (exact.optimal ? " (最优)" : "") << endl;
+        assert(exact.optimal && exact.lower_bound == exact.cost && !exact.path.empty());
+        
+        // 预算从小到大: 下界不超过最优代价, 当前解不优于最优代价, 下界达到当前代价即报告最优
+        SearchLimits limits;
+        for (long long budget : {10LL, 200LL, 2000LL, 20000LL, 2000000LL}) {
+            limits.max_expansions = budget;
+            AnytimeResult partial = graph.findMinCostPath(0, NODES - 1, limits);
+            assert(partial.lower_bound <= exact.cost);
+            assert(partial.path.empty() == (partial.cost == INT_MAX));
+            if (!partial.path.empty()) {
+                assert(partial.cost >= exact.cost && partial.lower_bound <= partial.cost);
+                assert(partial.optimal == (partial.lower_bound == partial.cost));
+            }
+            if (partial.optimal) {
+                assert(partial.cost == exact.cost);
+                cout << "预算" << budget << ": 已证明最优，代价=" << partial.cost << endl;
+            } else {
+                cout << "预算" << budget << ": 下界=" << partial.lower_bound
+                     << (partial.path.empty() ? ", 暂无路径" : ", 当前代价=" + to_string(partial.cost)) << endl;
+            }
+        }
+        assert(graph.findMinCostPath(0, NODES - 1, limits).optimal);
+    }
+    
     cout << "\n=== 测试用例结束 ===" << endl;
 }
 